@@ -18,8 +18,17 @@
 #include <queue>
 #include <set>
 #include <cmath>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
 #include "solution.h"
 #include "node.h"
+#include "distance_matrix.h"
+#include "greedy.h"
+#include "grasp.h"
 
 struct compare_nodes_by_upper_bound {
   bool operator()(Node node1, Node node2) {
@@ -37,69 +46,175 @@ struct compare_nodes_by_depth {
 class Branch_Bound {
  public:
   Branch_Bound();
-  Solution solve(const Problem& problem, int m, double lower_bound, int& generated_nodes, bool depth_search = false);
+  Solution solve(const Problem& problem, int m, const Solution& incumbent, int& generated_nodes, bool depth_search = false);
+  Solution solve(const Problem& problem, const Distance_Matrix& distances, int m, const Solution& incumbent, int& generated_nodes, bool depth_search = false);
+  void set_time_limit(double seconds);
+  void set_concurrent_heuristic(int lrc_size);
  private:
-  int calculate_remaining_edges(int actual_points, int solution_size);
-  double calculate_upper_bound(const Solution& solution, const Problem& problem, const std::vector<std::vector<double>>& distances, int m);
-  std::vector<std::vector<double>> calculate_distances(const Problem& problem);
+  std::vector<int> calculate_branching_order(const Distance_Matrix& distances, int m);
+  std::vector<double> calculate_point_bounds(const std::vector<int>& order, const Distance_Matrix& distances, int m);
+  double calculate_upper_bound(const Solution& solution, int tag, const std::vector<int>& order, const std::vector<double>& point_bounds, double lower_bound, const Distance_Matrix& distances, int m);
+  double time_limit_{0};
+  int heuristic_lrc_size_{0};
 };
 
 Branch_Bound::Branch_Bound() {}
 
-int Branch_Bound::calculate_remaining_edges(int actual_points, int solution_size) {
-  return (solution_size * (solution_size - 1) - actual_points * (actual_points - 1)) / 2;
+/**
+ * @brief Limits the time of each call to solve, 0 means no limit. The best
+ *        solution found so far is returned when the limit is reached
+ */
+void Branch_Bound::set_time_limit(double seconds) {
+  time_limit_ = seconds;
 }
 
-double Branch_Bound::calculate_upper_bound(const Solution& solution, const Problem& problem, const std::vector<std::vector<double>>& distances, int m) {
-  double max_distance{0};
-  for (int i{0}; i < problem.size(); ++i) {
-    if (solution.has_point(i)) continue;
-    for (int j{0}; j < problem.size(); ++j) {
-      if (distances[i][j] > max_distance) max_distance = distances[i][j];
+/**
+ * @brief Sets the list size of the GRASP that runs alongside the tree search
+ *        feeding improved incumbents into the shared lower bound. It is
+ *        disabled by default (0) because its timing makes the generated nodes
+ *        vary between runs with the same seed
+ */
+void Branch_Bound::set_concurrent_heuristic(int lrc_size) {
+  heuristic_lrc_size_ = lrc_size;
+}
+
+/**
+ * @brief Orders the points by decreasing sum of their m - 1 largest distances,
+ *        so the points most likely to be in a good solution are branched first
+ */
+std::vector<int> Branch_Bound::calculate_branching_order(const Distance_Matrix& distances, int m) {
+  std::vector<int> order;
+  for (int i{0}; i < distances.size(); ++i) {
+    order.push_back(i);
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return distances.top_sum(a, m - 1) > distances.top_sum(b, m - 1);
+  });
+  return order;
+}
+
+/**
+ * @brief Calculates, for each position of the branching order, an upper bound
+ *        of any solution containing that point. Each point of a solution adds
+ *        at most half of the sum of its m - 1 largest distances, so the bound is
+ *        the point's half plus the m - 1 largest halves of the other points.
+ *        A point whose bound is below the lower bound is dominated and can
+ *        never enter a solution better than the incumbent
+ */
+std::vector<double> Branch_Bound::calculate_point_bounds(const std::vector<int>& order, const Distance_Matrix& distances, int m) {
+  double first_sums{0};
+  for (int i{0}; i < m && i < order.size(); ++i) {
+    first_sums += distances.top_sum(order[i], m - 1) / 2;
+  }
+  std::vector<double> point_bounds;
+  for (int i{0}; i < order.size(); ++i) {
+    double half = distances.top_sum(order[i], m - 1) / 2;
+    if (i < m) {
+      point_bounds.push_back(first_sums);
+    } else {
+      point_bounds.push_back(first_sums - distances.top_sum(order[m - 1], m - 1) / 2 + half);
     }
   }
-  return solution.evaluate(problem) + max_distance * calculate_remaining_edges(solution.size(), m);
+  return point_bounds;
 }
 
-std::vector<std::vector<double>> Branch_Bound::calculate_distances(const Problem& problem) {
-  std::vector<std::vector<double>> distances;
-  for (int i{0}; i < problem.size(); ++i) {
-    std::vector<double> row;
-    for (int j{0}; j < problem.size(); ++j) {
-      row.push_back(euclidean_distance(problem[i], problem[j]));
+/**
+ * @brief Calculates an upper bound of the solutions that complete the given
+ *        partial solution with points after position tag in the branching
+ *        order. Each candidate c can add at most its distance to the partial
+ *        solution plus half of its remaining - 1 largest distances, so the bound
+ *        adds the remaining largest of those values
+ */
+double Branch_Bound::calculate_upper_bound(const Solution& solution, int tag, const std::vector<int>& order, const std::vector<double>& point_bounds, double lower_bound, const Distance_Matrix& distances, int m) {
+  int remaining = m - solution.size();
+  std::vector<double> contributions;
+  for (int i{tag + 1}; i < order.size(); ++i) {
+    if (point_bounds[i] < lower_bound) continue;
+    double contribution = distances.top_sum(order[i], remaining - 1) / 2;
+    for (int point: solution) {
+      contribution += distances(order[i], point);
     }
-    distances.push_back(row);
+    contributions.push_back(contribution);
+  }
+  if (contributions.size() < remaining) return -std::numeric_limits<double>::infinity();
+  std::partial_sort(contributions.begin(), contributions.begin() + remaining, contributions.end(), std::greater<double>());
+  double upper_bound = distances.evaluate(solution);
+  for (int i{0}; i < remaining; ++i) {
+    upper_bound += contributions[i];
   }
-  return distances;
+  return upper_bound;
 }
 
-Solution Branch_Bound::solve(const Problem& problem, int m, double lower_bound, int& generated_nodes, bool depth_search) {
-  Solution best_solution;
-  std::vector<std::vector<double>> distances = calculate_distances(problem);
+/**
+ * @brief Solves the problem starting from the given incumbent, which gives the
+ *        initial lower bound. A greedy solution is used if it is not complete.
+ *        The best solution known is always returned, even if the time limit
+ *        stops the search or nothing improves the incumbent
+ */
+Solution Branch_Bound::solve(const Problem& problem, int m, const Solution& incumbent, int& generated_nodes, bool depth_search) {
+  return solve(problem, Distance_Matrix(problem), m, incumbent, generated_nodes, depth_search);
+}
+
+/**
+ * @brief Solves the problem reusing distances already computed for it
+ */
+Solution Branch_Bound::solve(const Problem& problem, const Distance_Matrix& distances, int m, const Solution& incumbent, int& generated_nodes, bool depth_search) {
+  Solution best_solution = incumbent.size() == m ? incumbent : Greedy().solve(problem, m);
+  std::mutex best_solution_mutex;
+  std::atomic<double> lower_bound{best_solution.evaluate(problem)};
+  std::atomic<bool> finished{false};
+  auto start = std::chrono::steady_clock::now();
+  auto out_of_time = [&] {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return time_limit_ > 0 && elapsed.count() > time_limit_;
+  };
+  auto improve = [&](const Solution& solution) {
+    if (solution.size() != m) return;
+    double value = solution.evaluate(problem);
+    std::lock_guard<std::mutex> lock(best_solution_mutex);
+    if (value > lower_bound) {
+      best_solution = solution;
+      lower_bound = value;
+    }
+  };
+  std::thread heuristic;
+  if (heuristic_lrc_size_ > 0) {
+    heuristic = std::thread([&] {
+      GRASP grasp;
+      grasp.set_stop_condition([&] { return finished || out_of_time(); });
+      while (!finished && !out_of_time()) {
+        improve(grasp.solve(problem, m, 1, heuristic_lrc_size_));
+      }
+    });
+  }
+  std::vector<int> order = calculate_branching_order(distances, m);
+  std::vector<double> point_bounds = calculate_point_bounds(order, distances, m);
   std::priority_queue<Node, std::vector<Node>, compare_nodes_by_upper_bound> nodes_by_upper_bound;
   std::priority_queue<Node, std::vector<Node>, compare_nodes_by_depth> nodes_by_depth;
-  Node exploring_node(best_solution, lower_bound, -1, 0);
+  Node exploring_node(Solution(), calculate_upper_bound(Solution(), -1, order, point_bounds, lower_bound, distances, m), -1, 0);
   depth_search ? nodes_by_depth.push(exploring_node) : nodes_by_upper_bound.push(exploring_node);
   generated_nodes = 1;
   while (depth_search ? !nodes_by_depth.empty() : !nodes_by_upper_bound.empty()) {
+    if (out_of_time()) break;
     exploring_node = depth_search ? nodes_by_depth.top() : nodes_by_upper_bound.top();
     depth_search ? nodes_by_depth.pop() : nodes_by_upper_bound.pop();
     if (exploring_node.get_upper_bound() < lower_bound) continue;
-    for (int i{exploring_node.get_tag() + 1}; i < (problem.size() - (m - exploring_node.get_depth())); ++i) {
+    for (int i{exploring_node.get_tag() + 1}; i <= (problem.size() - (m - exploring_node.get_depth())); ++i) {
+      if (out_of_time()) break;
       Solution new_solution = exploring_node.get_solution();
       if (new_solution.size() == m) continue;
-      new_solution.insert(i);
+      if (point_bounds[i] < lower_bound) continue;
+      new_solution.insert(order[i]);
       generated_nodes++;
-      double upper_bound = calculate_upper_bound(new_solution, problem, distances, m);
+      double upper_bound = calculate_upper_bound(new_solution, i, order, point_bounds, lower_bound, distances, m);
       if (upper_bound < lower_bound) continue;
       Node new_node(new_solution, upper_bound, i, exploring_node.get_depth() + 1);
       depth_search ? nodes_by_depth.push(new_node) : nodes_by_upper_bound.push(new_node);
     }
-    if (exploring_node.get_solution().size() == m && exploring_node.get_solution().evaluate(problem) > best_solution.evaluate(problem)) {
-      best_solution = exploring_node.get_solution();
-      lower_bound = best_solution.evaluate(problem);
-    }
+    if (exploring_node.get_solution().size() == m) improve(exploring_node.get_solution());
   }
+  finished = true;
+  if (heuristic.joinable()) heuristic.join();
   return best_solution;
 }
 
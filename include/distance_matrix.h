@@ -0,0 +1,144 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Diseño y Análisis de Algoritmos
+ *
+ * @author Miguel Luna García
+ * @since 21 Apr 2023
+ * @file distance_matrix.h
+ * @brief Distance_Matrix class
+ *        This class precomputes the distances between the points of a problem
+ */
+
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include "problem.h"
+#include "solution.h"
+
+/**
+ * @brief Defines the distances between every pair of points of a problem,
+ *        along with the distances of each point sorted in decreasing order
+ */
+class Distance_Matrix {
+ public:
+  Distance_Matrix(const Problem& problem, bool sort_distances = true);
+  double operator()(int i, int j) const;
+  int size() const;
+  double top_sum(int i, int k) const;
+  double evaluate(const Solution& solution) const;
+  void update(const Problem& problem, int i);
+  void erase(int i);
+  void refresh();
+ private:
+  std::vector<std::vector<double>> distances_;
+  std::vector<std::vector<double>> top_sums_;
+};
+
+/**
+ * @brief Computes the distances of the problem. Sorting them costs
+ *        O(n^2 log n) and is only needed by top_sum, so it can be skipped and
+ *        left to a later refresh
+ */
+Distance_Matrix::Distance_Matrix(const Problem& problem, bool sort_distances) {
+  for (int i{0}; i < problem.size(); ++i) {
+    std::vector<double> row;
+    for (int j{0}; j < problem.size(); ++j) {
+      row.push_back(euclidean_distance(problem[i], problem[j]));
+    }
+    distances_.push_back(row);
+  }
+  if (sort_distances) refresh();
+}
+
+/**
+ * @brief Sorts the distances of every point again after the matrix has been
+ *        updated. It must be called before top_sum is used, and before the
+ *        matrix is shared with other threads
+ */
+void Distance_Matrix::refresh() {
+  top_sums_.clear();
+  for (int i{0}; i < size(); ++i) {
+    std::vector<double> sorted;
+    for (int j{0}; j < size(); ++j) {
+      if (j != i) sorted.push_back(distances_[i][j]);
+    }
+    std::sort(sorted.begin(), sorted.end(), std::greater<double>());
+    std::vector<double> sums{0};
+    for (double distance: sorted) {
+      sums.push_back(sums.back() + distance);
+    }
+    top_sums_.push_back(sums);
+  }
+}
+
+double Distance_Matrix::operator()(int i, int j) const {
+  return distances_[i][j];
+}
+
+int Distance_Matrix::size() const {
+  return distances_.size();
+}
+
+/**
+ * @brief Sum of the k largest distances from point i to the other points
+ * @throw std::logic_error if the matrix was updated and not refreshed
+ */
+double Distance_Matrix::top_sum(int i, int k) const {
+  if (k <= 0) return 0;
+  if (top_sums_.size() != size()) throw std::logic_error("Distance_Matrix updated without refresh");
+  return top_sums_[i][std::min<int>(k, top_sums_[i].size() - 1)];
+}
+
+double Distance_Matrix::evaluate(const Solution& solution) const {
+  double sum_of_distances{0};
+  for (std::set<int>::iterator point{solution.begin()}; point != solution.end(); ++point) {
+    std::set<int>::iterator other_point{point};
+    for (++other_point; other_point != solution.end(); ++other_point) {
+      sum_of_distances += distances_[*point][*other_point];
+    }
+  }
+  return sum_of_distances;
+}
+
+/**
+ * @brief Recomputes the distances of point i after it has moved, or adds them
+ *        if i is a new point appended to the problem. The sorted distances are
+ *        discarded until refresh is called
+ */
+void Distance_Matrix::update(const Problem& problem, int i) {
+  if (i == size()) {
+    for (int j{0}; j < size(); ++j) {
+      distances_[j].push_back(0);
+    }
+    distances_.push_back(std::vector<double>(size() + 1, 0));
+  }
+  for (int j{0}; j < size(); ++j) {
+    distances_[i][j] = distances_[j][i] = euclidean_distance(problem[i], problem[j]);
+  }
+  top_sums_.clear();
+}
+
+/**
+ * @brief Removes the distances of point i the same way Problem::erase does,
+ *        moving the last point to position i
+ */
+void Distance_Matrix::erase(int i) {
+  int last = size() - 1;
+  for (int j{0}; j < size(); ++j) {
+    distances_[j][i] = distances_[j][last];
+  }
+  distances_[i] = distances_[last];
+  distances_.pop_back();
+  for (int j{0}; j < size(); ++j) {
+    distances_[j].pop_back();
+  }
+  top_sums_.clear();
+}
+
+#endif  // DISTANCE_MATRIX_H
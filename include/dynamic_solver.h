@@ -0,0 +1,233 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Diseño y Análisis de Algoritmos
+ *
+ * @author Miguel Luna García
+ * @since 21 Apr 2023
+ * @file dynamic_solver.h
+ * @brief Dynamic_Solver class
+ *        This class keeps a solution good while the points of the problem change
+ */
+
+#ifndef DYNAMIC_SOLVER_H
+#define DYNAMIC_SOLVER_H
+
+#include <vector>
+#include "solution.h"
+#include "distance_matrix.h"
+
+/**
+ * @brief Keeps a solution of size m for a problem whose points are added,
+ *        removed or moved. The distances and the contribution of every point
+ *        to the solution are patched on each change and a bounded swap search
+ *        repairs the solution, instead of solving the problem again. Its
+ *        distances are never sorted, since the repair does not need top_sum
+ */
+class Dynamic_Solver {
+ public:
+  Dynamic_Solver(Problem& problem, const Solution& solution, int max_swaps = 10);
+  int add_point(const Point& point);
+  void remove_point(int i);
+  void move_point(int i, const Point& point);
+  const Solution& solution() const;
+  double value() const;
+  void set_max_swaps(int max_swaps);
+ private:
+  double contribution(int i) const;
+  void fill();
+  bool swap_in(int in);
+  bool swap_best();
+  void swap(int out, int in);
+  void repair(int changed_point, bool changed_solution);
+  Problem& problem_;
+  Distance_Matrix distances_;
+  Solution solution_;
+  int m_;
+  std::vector<double> contributions_;
+  double value_;
+  int max_swaps_;
+};
+
+Dynamic_Solver::Dynamic_Solver(Problem& problem, const Solution& solution, int max_swaps) : problem_(problem), distances_(problem, false), solution_(solution), m_(solution.size()), max_swaps_(max_swaps) {
+  for (int i{0}; i < problem_.size(); ++i) {
+    contributions_.push_back(contribution(i));
+  }
+  value_ = distances_.evaluate(solution_);
+}
+
+/**
+ * @brief Appends a point to the problem
+ * @return Index of the new point
+ */
+int Dynamic_Solver::add_point(const Point& point) {
+  int i = problem_.size();
+  problem_.push_back(point);
+  distances_.update(problem_, i);
+  contributions_.push_back(contribution(i));
+  fill();
+  repair(i, false);
+  return i;
+}
+
+/**
+ * @brief Removes point i from the problem. As in Problem::erase, the last
+ *        point takes index i
+ */
+void Dynamic_Solver::remove_point(int i) {
+  int last = problem_.size() - 1;
+  bool changed_solution = solution_.has_point(i);
+  if (changed_solution) {
+    value_ -= contributions_[i];
+    solution_.erase(i);
+    for (int j{0}; j < problem_.size(); ++j) {
+      contributions_[j] -= distances_(j, i);
+    }
+  }
+  if (solution_.has_point(last)) {
+    solution_.erase(last);
+    solution_.insert(i);
+  }
+  contributions_[i] = contributions_[last];
+  contributions_.pop_back();
+  problem_.erase(i);
+  distances_.erase(i);
+  fill();
+  if (changed_solution) repair(-1, true);
+}
+
+/**
+ * @brief Moves point i to a new position
+ */
+void Dynamic_Solver::move_point(int i, const Point& point) {
+  std::vector<double> old_distances;
+  for (int j{0}; j < problem_.size(); ++j) {
+    old_distances.push_back(distances_(i, j));
+  }
+  problem_[i] = point;
+  distances_.update(problem_, i);
+  bool changed_solution = solution_.has_point(i);
+  if (changed_solution) {
+    for (int j{0}; j < problem_.size(); ++j) {
+      contributions_[j] += distances_(i, j) - old_distances[j];
+    }
+    value_ += contribution(i) - contributions_[i];
+  }
+  contributions_[i] = contribution(i);
+  repair(i, changed_solution);
+}
+
+const Solution& Dynamic_Solver::solution() const {
+  return solution_;
+}
+
+double Dynamic_Solver::value() const {
+  return value_;
+}
+
+/**
+ * @brief Limits the swaps applied to repair the solution after each change
+ */
+void Dynamic_Solver::set_max_swaps(int max_swaps) {
+  max_swaps_ = max_swaps;
+}
+
+/**
+ * @brief Sum of the distances from point i to the points of the solution
+ */
+double Dynamic_Solver::contribution(int i) const {
+  double sum_of_distances{0};
+  for (int point: solution_) {
+    sum_of_distances += distances_(i, point);
+  }
+  return sum_of_distances;
+}
+
+/**
+ * @brief Adds the points with the largest contribution until the solution
+ *        has m points again, as long as the problem has enough of them
+ */
+void Dynamic_Solver::fill() {
+  while (solution_.size() < m_ && solution_.size() < problem_.size()) {
+    int best_point{-1};
+    for (int i{0}; i < problem_.size(); ++i) {
+      if (solution_.has_point(i)) continue;
+      if (best_point < 0 || contributions_[i] > contributions_[best_point]) best_point = i;
+    }
+    value_ += contributions_[best_point];
+    solution_.insert(best_point);
+    for (int j{0}; j < problem_.size(); ++j) {
+      contributions_[j] += distances_(j, best_point);
+    }
+  }
+}
+
+/**
+ * @brief Applies the best improving swap that brings point in into the solution
+ * @return true if a swap was applied
+ */
+bool Dynamic_Solver::swap_in(int in) {
+  if (solution_.has_point(in)) return false;
+  int best_out{-1};
+  double best_gain{1e-9};
+  for (int out: solution_) {
+    double gain = contributions_[in] - distances_(in, out) - contributions_[out];
+    if (gain > best_gain) {
+      best_gain = gain;
+      best_out = out;
+    }
+  }
+  if (best_out < 0) return false;
+  swap(best_out, in);
+  return true;
+}
+
+/**
+ * @brief Applies the best improving swap between a point in the solution and
+ *        a point outside it
+ * @return true if a swap was applied
+ */
+bool Dynamic_Solver::swap_best() {
+  int best_out{-1};
+  int best_in{-1};
+  double best_gain{1e-9};
+  for (int out: solution_) {
+    for (int in{0}; in < problem_.size(); ++in) {
+      if (solution_.has_point(in)) continue;
+      double gain = contributions_[in] - distances_(in, out) - contributions_[out];
+      if (gain > best_gain) {
+        best_gain = gain;
+        best_out = out;
+        best_in = in;
+      }
+    }
+  }
+  if (best_out < 0) return false;
+  swap(best_out, best_in);
+  return true;
+}
+
+void Dynamic_Solver::swap(int out, int in) {
+  value_ += contributions_[in] - distances_(in, out) - contributions_[out];
+  solution_.erase(out);
+  solution_.insert(in);
+  for (int j{0}; j < problem_.size(); ++j) {
+    contributions_[j] += distances_(j, in) - distances_(j, out);
+  }
+}
+
+/**
+ * @brief Restores a local optimum after a change. If only a point outside the
+ *        solution changed, the only swaps whose gain changed are the ones that
+ *        bring it in, so those are checked first and the search stops when
+ *        none improves. Otherwise up to max_swaps best swaps are applied
+ */
+void Dynamic_Solver::repair(int changed_point, bool changed_solution) {
+  if (!changed_solution && (changed_point < 0 || !swap_in(changed_point))) return;
+  for (int swaps{changed_solution ? 0 : 1}; swaps < max_swaps_; ++swaps) {
+    if (!swap_best()) return;
+  }
+}
+
+#endif  // DYNAMIC_SOLVER_H
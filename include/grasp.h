@@ -17,23 +17,53 @@
 #include <vector>
 #include <set>
 #include <cmath>
+#include <chrono>
+#include <functional>
+#include <random>
 #include "solution.h"
 
 class GRASP {
  public:
   GRASP();
   Solution solve(const Problem& problem, int k, int iterations, int lrc_size);
+  Solution solve(const Problem& problem, int k, int iterations, int lrc_size, std::mt19937& generator);
+  void set_time_limit(double seconds);
+  void set_stop_condition(std::function<bool()> stop);
  private:
   void insertLRC(std::set<int>& lrc, Solution remaining_points, const Problem& problem, int lrc_size);
+  bool stopped() const;
+  double time_limit_{0};
+  std::function<bool()> stop_;
 };
 
 GRASP::GRASP() {}
 
+/**
+ * @brief Limits the time of each call to solve, 0 means no limit. The best
+ *        solution found so far is returned when the limit is reached
+ */
+void GRASP::set_time_limit(double seconds) {
+  time_limit_ = seconds;
+}
+
+/**
+ * @brief Sets a condition checked during the construction and the local
+ *        search, so another thread can interrupt solve. An interrupted solve
+ *        may return an incomplete solution
+ */
+void GRASP::set_stop_condition(std::function<bool()> stop) {
+  stop_ = stop;
+}
+
+bool GRASP::stopped() const {
+  return stop_ && stop_();
+}
+
 void GRASP::insertLRC(std::set<int>& lrc, Solution remaining_points, const Problem& problem, int lrc_size) {
   Point center = remaining_points.centroid(problem);
-  while (lrc.size() < lrc_size) {
+  while (lrc.size() < lrc_size && remaining_points.size() > 0) {
     int best_point{0};
-    double best_distance{0};
+    double best_distance{-1};
     for (int point: remaining_points) {
       double distance{euclidean_distance(problem[point], center)};
       if (distance > best_distance) {
@@ -47,19 +77,36 @@ void GRASP::insertLRC(std::set<int>& lrc, Solution remaining_points, const Probl
 }
 
 
+/**
+ * @brief Solves the problem with a generator seeded from rand()
+ */
 Solution GRASP::solve(const Problem& problem, int k, int iterations, int lrc_size) {
+  std::mt19937 generator(rand());
+  return solve(problem, k, iterations, lrc_size, generator);
+}
+
+/**
+ * @brief Solves the problem drawing the random choices from the given
+ *        generator, so concurrent calls with their own generators are
+ *        reproducible
+ */
+Solution GRASP::solve(const Problem& problem, int k, int iterations, int lrc_size, std::mt19937& generator) {
   Solution best_solution;
+  auto start = std::chrono::steady_clock::now();
   for (int iteration{0}; iteration < iterations;) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (time_limit_ > 0 && elapsed.count() > time_limit_ && best_solution.size() == k) break;
+    if (stopped()) break;
     Solution solution;
     Solution remaining_points;
     for (int i{0}; i < problem.size(); ++i) {
       remaining_points.insert(i);
     }
     Point center = remaining_points.centroid(problem);
-    while (solution.size() < k) {
+    while (solution.size() < k && !stopped()) {
       std::set<int> lrc;
       insertLRC(lrc, remaining_points, problem, lrc_size);
-      int best_point = random(lrc);
+      int best_point = random(lrc, generator);
       solution.insert(best_point);
       remaining_points.erase(best_point);
       center = solution.centroid(problem);
@@ -68,12 +115,12 @@ Solution GRASP::solve(const Problem& problem, int k, int iterations, int lrc_siz
     double oldvalue = solution.evaluate(problem);
     double newvalue = oldvalue;
     do {
-      search_solution = solution.swap_search(problem, newvalue);
+      search_solution = solution.swap_search(problem, newvalue, stop_);
       if (newvalue > oldvalue) {
         solution = search_solution;
         oldvalue = newvalue;
       }
-    } while (newvalue > oldvalue);
+    } while (newvalue > oldvalue && !stopped());
     if (solution.evaluate(problem) > best_solution.evaluate(problem)) {
       best_solution = solution;
     } else {
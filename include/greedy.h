@@ -39,7 +39,7 @@ Solution Greedy::solve(const Problem& problem, int k) {
   Point center = remaining_points.centroid(problem);
   while (solution.size() < k) {
     int best_point{0};
-    double best_distance{0};
+    double best_distance{-1};
     for (int point: remaining_points) {
       double distance{euclidean_distance(problem[point], center)};
       if (distance > best_distance) {
@@ -36,7 +36,7 @@ Solution Local_Search::solve(const Problem& problem, int k) {
   Point center = remaining_points.centroid(problem);
   while (solution.size() < k) {
     int best_point{0};
-    double best_distance{0};
+    double best_distance{-1};
     for (int point: remaining_points) {
       double distance{euclidean_distance(problem[point], center)};
       if (distance > best_distance) {
@@ -0,0 +1,184 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Diseño y Análisis de Algoritmos
+ *
+ * @author Miguel Luna García
+ * @since 21 Apr 2023
+ * @file multi_query.h
+ * @brief Multi_Query class
+ *        This class solves the same problem for several subset sizes
+ */
+
+#ifndef MULTI_QUERY_H
+#define MULTI_QUERY_H
+
+#include <vector>
+#include <map>
+#include <iterator>
+#include <stdexcept>
+#include "solution.h"
+#include "distance_matrix.h"
+#include "branch_bound.h"
+
+/**
+ * @brief Solves a problem for many values of m. The distances are computed
+ *        once and every m starts from the solution of the closest m solved
+ *        before, adding or removing points and then improving it with a local
+ *        search, instead of starting from scratch
+ */
+class Multi_Query {
+ public:
+  Multi_Query(const Problem& problem);
+  const Distance_Matrix& distances() const;
+  Solution local_search(int m);
+  Solution branch_bound(int m, Branch_Bound& algorithm, int& generated_nodes, bool depth_search = false);
+ private:
+  void check_size(int m) const;
+  Solution warm_start(int m) const;
+  void improve(Solution& solution) const;
+  void remember(const Solution& solution);
+  const Problem& problem_;
+  Distance_Matrix distances_;
+  std::map<int, Solution> solutions_;
+};
+
+Multi_Query::Multi_Query(const Problem& problem) : problem_(problem), distances_(problem) {}
+
+const Distance_Matrix& Multi_Query::distances() const {
+  return distances_;
+}
+
+/**
+ * @throw std::invalid_argument if m is not in [1, n]
+ */
+void Multi_Query::check_size(int m) const {
+  if (m < 1 || m > distances_.size()) {
+    throw std::invalid_argument("m must be between 1 and " + std::to_string(distances_.size()));
+  }
+}
+
+/**
+ * @brief Builds a solution of size m from the closest size solved so far by
+ *        adding the point farthest from the solution or removing the point
+ *        closest to it, one at a time. Without previous solutions it starts
+ *        from the farthest pair of points
+ */
+Solution Multi_Query::warm_start(int m) const {
+  Solution solution;
+  std::map<int, Solution>::const_iterator next = solutions_.lower_bound(m);
+  if (next != solutions_.end() && (next->first == m || next == solutions_.begin() || next->first - m < m - std::prev(next)->first)) {
+    solution = next->second;
+  } else if (next != solutions_.begin()) {
+    solution = std::prev(next)->second;
+  } else {
+    int best_i{0};
+    int best_j{std::min(1, distances_.size() - 1)};
+    for (int i{0}; i < distances_.size(); ++i) {
+      for (int j{i + 1}; j < distances_.size(); ++j) {
+        if (distances_(i, j) > distances_(best_i, best_j)) {
+          best_i = i;
+          best_j = j;
+        }
+      }
+    }
+    solution.insert(best_i);
+    solution.insert(best_j);
+  }
+  while (solution.size() < m) {
+    int best_point{-1};
+    double best_contribution{-1};
+    for (int i{0}; i < distances_.size(); ++i) {
+      if (solution.has_point(i)) continue;
+      double contribution{0};
+      for (int point: solution) {
+        contribution += distances_(i, point);
+      }
+      if (contribution > best_contribution) {
+        best_contribution = contribution;
+        best_point = i;
+      }
+    }
+    solution.insert(best_point);
+  }
+  while (solution.size() > m) {
+    int worst_point{*solution.begin()};
+    double worst_contribution{-1};
+    for (int point: solution) {
+      double contribution{0};
+      for (int other_point: solution) {
+        contribution += distances_(point, other_point);
+      }
+      if (worst_contribution < 0 || contribution < worst_contribution) {
+        worst_contribution = contribution;
+        worst_point = point;
+      }
+    }
+    solution.erase(worst_point);
+  }
+  return solution;
+}
+
+/**
+ * @brief Applies the best swap between a point in the solution and a point
+ *        outside it until no swap improves the solution
+ */
+void Multi_Query::improve(Solution& solution) const {
+  std::vector<double> contributions(distances_.size(), 0);
+  for (int i{0}; i < distances_.size(); ++i) {
+    for (int point: solution) {
+      contributions[i] += distances_(i, point);
+    }
+  }
+  while (true) {
+    int best_out{-1};
+    int best_in{-1};
+    double best_gain{1e-9};
+    for (int out: solution) {
+      for (int in{0}; in < distances_.size(); ++in) {
+        if (solution.has_point(in)) continue;
+        double gain = contributions[in] - distances_(in, out) - contributions[out];
+        if (gain > best_gain) {
+          best_gain = gain;
+          best_out = out;
+          best_in = in;
+        }
+      }
+    }
+    if (best_out < 0) return;
+    solution.erase(best_out);
+    solution.insert(best_in);
+    for (int i{0}; i < distances_.size(); ++i) {
+      contributions[i] += distances_(i, best_in) - distances_(i, best_out);
+    }
+  }
+}
+
+void Multi_Query::remember(const Solution& solution) {
+  std::map<int, Solution>::iterator known = solutions_.find(solution.size());
+  if (known == solutions_.end() || distances_.evaluate(solution) > distances_.evaluate(known->second)) {
+    solutions_[solution.size()] = solution;
+  }
+}
+
+Solution Multi_Query::local_search(int m) {
+  check_size(m);
+  Solution solution = warm_start(m);
+  improve(solution);
+  remember(solution);
+  return solutions_[m];
+}
+
+/**
+ * @brief Solves the problem exactly for m, seeding the incumbent with the
+ *        warm started local search
+ */
+Solution Multi_Query::branch_bound(int m, Branch_Bound& algorithm, int& generated_nodes, bool depth_search) {
+  check_size(m);
+  Solution solution = algorithm.solve(problem_, distances_, m, local_search(m), generated_nodes, depth_search);
+  remember(solution);
+  return solutions_[m];
+}
+
+#endif  // MULTI_QUERY_H
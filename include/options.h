@@ -0,0 +1,211 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Diseño y Análisis de Algoritmos
+ *
+ * @author Miguel Luna García
+ * @since 21 Apr 2023
+ * @file options.h
+ * @brief Command line options
+ *        This file contains the options of the client and their parser
+ */
+
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <ctime>
+#include <stdexcept>
+
+/**
+ * @brief Defines the configuration of an execution of the client. The
+ *        defaults reproduce the complete sweep of every algorithm
+ */
+struct Options {
+  std::string instance_path;
+  bool greedy{true};
+  bool local_search{true};
+  bool grasp{true};
+  bool branch_bound{true};
+  std::vector<int> m_values{2, 3, 4, 5};
+  std::vector<int> iterations{10, 20};
+  std::vector<int> lrc_sizes{2, 3};
+  bool best_first{true};
+  bool depth_first{true};
+  bool greedy_bound{true};
+  bool grasp_bound{true};
+  int bound_iterations{30};
+  int bound_lrc_size{3};
+  int concurrent_lrc_size{0};
+  int threads{1};
+  double time_limit{0};
+  unsigned seed{unsigned(time(0))};
+  bool json{false};
+  bool multi_query{false};
+};
+
+void printUsage(std::ostream& os, const std::string& program) {
+  os << "Usage: " << program << " <instance_file|instance_folder> [options]" << std::endl
+     << "  -a, --algorithm LIST     greedy,local_search,grasp,bb (default: all)" << std::endl
+     << "  -m LIST                  subset sizes, e.g. 2,3 or 2-5 (default: 2-5)" << std::endl
+     << "  --iterations LIST        GRASP iterations without improvement (default: 10,20)" << std::endl
+     << "  --lrc LIST               GRASP restricted candidate list sizes (default: 2,3)" << std::endl
+     << "  --strategy S             Branch & Bound strategy: best, depth or both (default: both)" << std::endl
+     << "  --bound B                Branch & Bound lower bound: greedy, grasp or both (default: both)" << std::endl
+     << "  --bound-iterations N     GRASP iterations for the lower bound (default: 30)" << std::endl
+     << "  --bound-lrc N            GRASP list size for the lower bound (default: 3)" << std::endl
+     << "  --concurrent-lrc N       GRASP list size run alongside Branch & Bound, 0 disables it (default: 0)" << std::endl
+     << "  --multi                  solve every m of an instance from one preprocessing, warm starting" << std::endl
+     << "                           each m from the previous one (local search and Branch & Bound)" << std::endl
+     << "  -t, --threads N          executions run concurrently (default: 1). With more than one" << std::endl
+     << "                           thread CPU(s) is wall time and grows with the contention" << std::endl
+     << "  --time-limit SECONDS     time limit of each GRASP and Branch & Bound run (default: none)" << std::endl
+     << "  --seed N                 random seed, each GRASP execution derives its own from it" << std::endl
+     << "                           (default: current time)" << std::endl
+     << "  --format F               csv or json (default: csv)" << std::endl;
+}
+
+/**
+ * @brief Parses a list of integers such as "2,4,6" or "2-5"
+ */
+std::vector<int> parseIntList(const std::string& text) {
+  std::vector<int> values;
+  size_t begin{0};
+  while (begin <= text.size()) {
+    size_t end = text.find(',', begin);
+    if (end == std::string::npos) end = text.size();
+    std::string item = text.substr(begin, end - begin);
+    size_t dash = item.find('-', 1);
+    try {
+      if (dash == std::string::npos) {
+        values.push_back(std::stoi(item));
+      } else {
+        int first = std::stoi(item.substr(0, dash));
+        int last = std::stoi(item.substr(dash + 1));
+        for (int value{first}; value <= last; ++value) {
+          values.push_back(value);
+        }
+      }
+    } catch (const std::logic_error&) {
+      throw std::invalid_argument("Invalid list of integers: " + text);
+    }
+    begin = end + 1;
+  }
+  if (values.empty()) throw std::invalid_argument("Empty list of integers");
+  return values;
+}
+
+int parsePositive(const std::string& text, const std::string& option) {
+  std::vector<int> values = parseIntList(text);
+  if (values.size() != 1 || values[0] < 1) throw std::invalid_argument(option + " expects a positive integer");
+  return values[0];
+}
+
+/**
+ * @brief Parses the command line arguments
+ * @throw std::invalid_argument if an argument is not valid
+ */
+Options parseOptions(int argc, char** argv) {
+  Options options;
+  bool algorithm_selected{false};
+  for (int i{1}; i < argc; ++i) {
+    std::string argument = argv[i];
+    if (argument.empty() || argument[0] != '-') {
+      if (!options.instance_path.empty()) throw std::invalid_argument("Unexpected argument: " + argument);
+      options.instance_path = argument;
+      continue;
+    }
+    if (argument == "--json") {
+      options.json = true;
+      continue;
+    }
+    if (argument == "--multi") {
+      options.multi_query = true;
+      continue;
+    }
+    if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + argument);
+    std::string value = argv[++i];
+    if (argument == "-a" || argument == "--algorithm") {
+      if (!algorithm_selected) {
+        options.greedy = options.local_search = options.grasp = options.branch_bound = false;
+        algorithm_selected = true;
+      }
+      size_t begin{0};
+      while (begin <= value.size()) {
+        size_t end = value.find(',', begin);
+        if (end == std::string::npos) end = value.size();
+        std::string name = value.substr(begin, end - begin);
+        if (name == "greedy") {
+          options.greedy = true;
+        } else if (name == "local_search") {
+          options.local_search = true;
+        } else if (name == "grasp") {
+          options.grasp = true;
+        } else if (name == "bb" || name == "branch_bound") {
+          options.branch_bound = true;
+        } else {
+          throw std::invalid_argument("Unknown algorithm: " + name);
+        }
+        begin = end + 1;
+      }
+    } else if (argument == "-m") {
+      options.m_values = parseIntList(value);
+      for (int m: options.m_values) {
+        if (m < 2) throw std::invalid_argument("-m values must be at least 2");
+      }
+    } else if (argument == "--iterations") {
+      options.iterations = parseIntList(value);
+      for (int iterations: options.iterations) {
+        if (iterations < 1) throw std::invalid_argument("--iterations values must be positive");
+      }
+    } else if (argument == "--lrc") {
+      options.lrc_sizes = parseIntList(value);
+      for (int lrc_size: options.lrc_sizes) {
+        if (lrc_size < 1) throw std::invalid_argument("--lrc values must be positive");
+      }
+    } else if (argument == "--strategy") {
+      if (value != "best" && value != "depth" && value != "both") throw std::invalid_argument("Unknown strategy: " + value);
+      options.best_first = value != "depth";
+      options.depth_first = value != "best";
+    } else if (argument == "--bound") {
+      if (value != "greedy" && value != "grasp" && value != "both") throw std::invalid_argument("Unknown lower bound: " + value);
+      options.greedy_bound = value != "grasp";
+      options.grasp_bound = value != "greedy";
+    } else if (argument == "--bound-iterations") {
+      options.bound_iterations = parsePositive(value, argument);
+    } else if (argument == "--bound-lrc") {
+      options.bound_lrc_size = parsePositive(value, argument);
+    } else if (argument == "--concurrent-lrc") {
+      std::vector<int> values = parseIntList(value);
+      if (values.size() != 1 || values[0] < 0) throw std::invalid_argument(argument + " expects a non-negative integer");
+      options.concurrent_lrc_size = values[0];
+    } else if (argument == "-t" || argument == "--threads") {
+      options.threads = parsePositive(value, argument);
+    } else if (argument == "--time-limit") {
+      try {
+        options.time_limit = std::stod(value);
+      } catch (const std::logic_error&) {
+        throw std::invalid_argument("Invalid time limit: " + value);
+      }
+      if (options.time_limit < 0) throw std::invalid_argument("Invalid time limit: " + value);
+    } else if (argument == "--seed") {
+      try {
+        options.seed = std::stoul(value);
+      } catch (const std::logic_error&) {
+        throw std::invalid_argument("Invalid seed: " + value);
+      }
+    } else if (argument == "--format") {
+      if (value != "csv" && value != "json") throw std::invalid_argument("Unknown format: " + value);
+      options.json = value == "json";
+    } else {
+      throw std::invalid_argument("Unknown option: " + argument);
+    }
+  }
+  if (options.instance_path.empty()) throw std::invalid_argument("Missing instance");
+  return options;
+}
+
+#endif  // OPTIONS_H
@@ -62,6 +62,16 @@ class Problem {
     points_.pop_back();
   }
 
+  /**
+   * @brief Removes a point in constant time by moving the last point to its
+   *        position, so the last index becomes i
+   * @param i Index of the point to remove
+  */
+  void erase(int i) {
+    points_[i] = points_.back();
+    points_.pop_back();
+  }
+
  private:
   std::vector<Point> points_;
 };
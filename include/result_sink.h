@@ -0,0 +1,405 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Diseño y Análisis de Algoritmos
+ *
+ * @author Miguel Luna García
+ * @since 21 Apr 2023
+ * @file result_sink.h
+ * @brief Result sinks
+ *        This file contains the sinks the client writes its results to
+ */
+
+#ifndef RESULT_SINK_H
+#define RESULT_SINK_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <variant>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "solution.h"
+
+/**
+ * @brief Columns a result can be written with
+ */
+enum class Field {
+  kInstance,
+  kN,
+  kK,
+  kM,
+  kIterations,
+  kLrcSize,
+  kZ,
+  kSolution,
+  kCpu,
+  kGeneratedNodes
+};
+
+/**
+ * @brief Group of results produced by the same algorithm configuration
+ */
+struct Section {
+  std::string title;
+  std::vector<Field> fields;
+};
+
+/**
+ * @brief Outcome of a single execution of an algorithm
+ */
+struct Result {
+  std::string instance;
+  int n{0};
+  int k{0};
+  int m{0};
+  int iterations{0};
+  int lrc_size{0};
+  double z{0};
+  Solution solution;
+  double cpu{0};
+  int generated_nodes{0};
+};
+
+/**
+ * @brief Destination of the results, independent of the algorithms
+ */
+class Result_Sink {
+ public:
+  virtual ~Result_Sink() {}
+  virtual void begin_section(const Section& section) = 0;
+  virtual void write(const Result& result) = 0;
+  virtual void flush() {}
+};
+
+/**
+ * @brief Base of the sinks that format results into a buffer and write it to
+ *        a stream once it grows past buffer_size bytes
+ */
+class Buffered_Sink : public Result_Sink {
+ public:
+  ~Buffered_Sink();
+  void flush() override;
+ protected:
+  Buffered_Sink(std::ostream& os, size_t buffer_size);
+  void flush_if_full();
+  std::ostringstream buffer_;
+ private:
+  std::ostream& os_;
+  size_t buffer_size_;
+};
+
+/**
+ * @brief Writes the results as comma separated values, one header per section
+ */
+class CSV_Sink : public Buffered_Sink {
+ public:
+  CSV_Sink(std::ostream& os, size_t buffer_size = 1 << 16);
+  void begin_section(const Section& section) override;
+  void write(const Result& result) override;
+ private:
+  std::vector<Field> fields_;
+};
+
+/**
+ * @brief Writes the results as JSON lines, one object per result
+ */
+class JSON_Lines_Sink : public Buffered_Sink {
+ public:
+  JSON_Lines_Sink(std::ostream& os, size_t buffer_size = 1 << 16);
+  void begin_section(const Section& section) override;
+  void write(const Result& result) override;
+ private:
+  Section section_;
+};
+
+/**
+ * @brief Keeps the results in memory
+ */
+class Memory_Sink : public Result_Sink {
+ public:
+  Memory_Sink();
+  void begin_section(const Section& section) override;
+  void write(const Result& result) override;
+  const std::vector<Section>& sections() const;
+  const std::vector<Result>& results() const;
+ private:
+  std::vector<Section> sections_;
+  std::vector<Result> results_;
+};
+
+/**
+ * @brief Forwards the results to another sink from a background thread, so
+ *        the callers never wait for the output
+ */
+class Async_Sink : public Result_Sink {
+ public:
+  Async_Sink(Result_Sink& sink);
+  ~Async_Sink();
+  void begin_section(const Section& section) override;
+  void write(const Result& result) override;
+  void flush() override;
+  void close();
+ private:
+  typedef std::variant<Section, Result> Event;
+  void push(Event event);
+  void forward(const Event& event);
+  void run();
+  Result_Sink& sink_;
+  std::deque<Event> pending_;
+  std::mutex mutex_;
+  std::condition_variable pending_changed_;
+  bool busy_{false};
+  bool closed_{false};
+  bool drained_{false};
+  std::thread writer_;
+};
+
+const char* csv_header(Field field) {
+  switch (field) {
+    case Field::kInstance: return "Problema";
+    case Field::kN: return "n";
+    case Field::kK: return "k";
+    case Field::kM: return "m";
+    case Field::kIterations: return "Iter";
+    case Field::kLrcSize: return "|LRC|";
+    case Field::kZ: return "z";
+    case Field::kSolution: return "S";
+    case Field::kCpu: return "CPU(s)";
+    case Field::kGeneratedNodes: return "nodos";
+  }
+  return "";
+}
+
+const char* json_key(Field field) {
+  switch (field) {
+    case Field::kInstance: return "instance";
+    case Field::kN: return "n";
+    case Field::kK: return "k";
+    case Field::kM: return "m";
+    case Field::kIterations: return "iterations";
+    case Field::kLrcSize: return "lrc_size";
+    case Field::kZ: return "z";
+    case Field::kSolution: return "solution";
+    case Field::kCpu: return "cpu";
+    case Field::kGeneratedNodes: return "generated_nodes";
+  }
+  return "";
+}
+
+/**
+ * @brief Writes a string as a JSON string literal
+ */
+void write_json_string(std::ostream& os, const std::string& text) {
+  os << '"';
+  for (char c: text) {
+    if (c == '"' || c == '\\') {
+      os << '\\' << c;
+    } else if (c == '\n') {
+      os << "\\n";
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      const char* kHexDigits = "0123456789abcdef";
+      os << "\\u00" << kHexDigits[c >> 4] << kHexDigits[c & 0xf];
+    } else {
+      os << c;
+    }
+  }
+  os << '"';
+}
+
+Buffered_Sink::Buffered_Sink(std::ostream& os, size_t buffer_size) : os_(os), buffer_size_(buffer_size) {}
+
+Buffered_Sink::~Buffered_Sink() {
+  flush();
+}
+
+void Buffered_Sink::flush_if_full() {
+  if (static_cast<size_t>(buffer_.tellp()) >= buffer_size_) flush();
+}
+
+void Buffered_Sink::flush() {
+  os_ << buffer_.str();
+  os_.flush();
+  buffer_.str("");
+}
+
+CSV_Sink::CSV_Sink(std::ostream& os, size_t buffer_size) : Buffered_Sink(os, buffer_size) {}
+
+void CSV_Sink::begin_section(const Section& section) {
+  fields_ = section.fields;
+  buffer_ << section.title << '\n';
+  for (int i{0}; i < fields_.size(); ++i) {
+    buffer_ << (i == 0 ? "" : ",") << csv_header(fields_[i]);
+  }
+  buffer_ << '\n';
+  flush_if_full();
+}
+
+void CSV_Sink::write(const Result& result) {
+  for (int i{0}; i < fields_.size(); ++i) {
+    if (i != 0) buffer_ << ',';
+    switch (fields_[i]) {
+      case Field::kInstance: buffer_ << result.instance; break;
+      case Field::kN: buffer_ << result.n; break;
+      case Field::kK: buffer_ << result.k; break;
+      case Field::kM: buffer_ << result.m; break;
+      case Field::kIterations: buffer_ << result.iterations; break;
+      case Field::kLrcSize: buffer_ << result.lrc_size; break;
+      case Field::kZ: buffer_ << result.z; break;
+      case Field::kSolution: buffer_ << result.solution; break;
+      case Field::kCpu: buffer_ << result.cpu; break;
+      case Field::kGeneratedNodes: buffer_ << result.generated_nodes; break;
+    }
+  }
+  buffer_ << '\n';
+  flush_if_full();
+}
+
+JSON_Lines_Sink::JSON_Lines_Sink(std::ostream& os, size_t buffer_size) : Buffered_Sink(os, buffer_size) {}
+
+void JSON_Lines_Sink::begin_section(const Section& section) {
+  section_ = section;
+}
+
+void JSON_Lines_Sink::write(const Result& result) {
+  buffer_ << "{\"algorithm\":";
+  write_json_string(buffer_, section_.title);
+  for (Field field: section_.fields) {
+    buffer_ << ",\"" << json_key(field) << "\":";
+    switch (field) {
+      case Field::kInstance: write_json_string(buffer_, result.instance); break;
+      case Field::kN: buffer_ << result.n; break;
+      case Field::kK: buffer_ << result.k; break;
+      case Field::kM: buffer_ << result.m; break;
+      case Field::kIterations: buffer_ << result.iterations; break;
+      case Field::kLrcSize: buffer_ << result.lrc_size; break;
+      case Field::kZ: buffer_ << result.z; break;
+      case Field::kSolution: {
+        buffer_ << '[';
+        for (std::set<int>::iterator point{result.solution.begin()}; point != result.solution.end(); ++point) {
+          buffer_ << (point == result.solution.begin() ? "" : ",") << *point;
+        }
+        buffer_ << ']';
+        break;
+      }
+      case Field::kCpu: buffer_ << result.cpu; break;
+      case Field::kGeneratedNodes: buffer_ << result.generated_nodes; break;
+    }
+  }
+  buffer_ << "}\n";
+  flush_if_full();
+}
+
+Memory_Sink::Memory_Sink() {}
+
+void Memory_Sink::begin_section(const Section& section) {
+  sections_.push_back(section);
+}
+
+void Memory_Sink::write(const Result& result) {
+  results_.push_back(result);
+}
+
+const std::vector<Section>& Memory_Sink::sections() const {
+  return sections_;
+}
+
+const std::vector<Result>& Memory_Sink::results() const {
+  return results_;
+}
+
+Async_Sink::Async_Sink(Result_Sink& sink) : sink_(sink) {
+  writer_ = std::thread(&Async_Sink::run, this);
+}
+
+Async_Sink::~Async_Sink() {
+  close();
+}
+
+void Async_Sink::begin_section(const Section& section) {
+  push(section);
+}
+
+void Async_Sink::write(const Result& result) {
+  push(result);
+}
+
+/**
+ * @brief Queues the event for the writer thread. Once the writer thread has
+ *        stopped the event is written synchronously instead
+ */
+void Async_Sink::push(Event event) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (drained_) {
+      forward(event);
+      return;
+    }
+    pending_.push_back(std::move(event));
+  }
+  pending_changed_.notify_all();
+}
+
+void Async_Sink::forward(const Event& event) {
+  if (std::holds_alternative<Section>(event)) {
+    sink_.begin_section(std::get<Section>(event));
+  } else {
+    sink_.write(std::get<Result>(event));
+  }
+}
+
+/**
+ * @brief Waits until every pending result has reached the underlying sink
+ *        and flushes it
+ */
+void Async_Sink::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  pending_changed_.wait(lock, [this] { return pending_.empty() && !busy_; });
+  sink_.flush();
+}
+
+/**
+ * @brief Writes the remaining results and stops the background thread. The
+ *        events queued while it stops are written here, under the lock
+ */
+void Async_Sink::close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return;
+    closed_ = true;
+  }
+  pending_changed_.notify_all();
+  writer_.join();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const Event& event: pending_) {
+    forward(event);
+  }
+  pending_.clear();
+  sink_.flush();
+  drained_ = true;
+}
+
+void Async_Sink::run() {
+  std::deque<Event> batch;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    pending_changed_.wait(lock, [this] { return !pending_.empty() || closed_; });
+    if (pending_.empty()) return;
+    batch.swap(pending_);
+    busy_ = true;
+    lock.unlock();
+    for (const Event& event: batch) {
+      forward(event);
+    }
+    batch.clear();
+    lock.lock();
+    busy_ = false;
+    pending_changed_.notify_all();
+  }
+}
+
+#endif  // RESULT_SINK_H
@@ -18,6 +18,7 @@
 #include <vector>
 #include <set>
 #include <cmath>
+#include <functional>
 #include "problem.h"
 
 /**
@@ -36,9 +37,9 @@ class Solution {
   const bool operator==(const Solution& other) const;
   const bool operator!=(const Solution& other) const;
   Point centroid(const Problem& problem) const;
-  Solution swap_search(const Problem& problem, double& value) const;
+  Solution swap_search(const Problem& problem, double& value, const std::function<bool()>& stop = nullptr) const;
   bool has_point(int i) const;
-  friend std::ostream& operator<<(std::ostream& os, Solution& solution);
+  friend std::ostream& operator<<(std::ostream& os, const Solution& solution);
  private:
   std::set<int> points_;
 };
@@ -102,15 +103,19 @@ Point Solution::centroid(const Problem& points) const {
   return centroid;
 }
 
-Solution Solution::swap_search(const Problem& problem, double& value) const {
+/**
+ * @brief Finds the best swap of a point of the solution with a point outside
+ *        it. The optional stop condition is checked for every point of the
+ *        solution and ends the search early with the best swap found so far
+ */
+Solution Solution::swap_search(const Problem& problem, double& value, const std::function<bool()>& stop) const {
   double best_evaluation{value};
-  Solution best_solution = *this;
+  int best_out{-1};
+  int best_in{-1};
   for (int point: points_) {
+    if (stop && stop()) break;
     for (int i{0}; i < problem.size(); ++i) {
       if (points_.find(i) == points_.end()) {
-        Solution new_solution = *this;
-        new_solution.points_.erase(point);
-        new_solution.points_.insert(i);
         double new_evaluation{value};
         for (int point_check: points_) {
           if (point_check != point) {
@@ -120,11 +125,17 @@ Solution Solution::swap_search(const Problem& problem, double& value) const {
         }
         if (new_evaluation > best_evaluation) {
           best_evaluation = new_evaluation;
-          best_solution = new_solution;
+          best_out = point;
+          best_in = i;
         }
       }
     }
   }
+  Solution best_solution = *this;
+  if (best_out >= 0) {
+    best_solution.points_.erase(best_out);
+    best_solution.points_.insert(best_in);
+  }
   value = best_evaluation;
   return best_solution;
 }
@@ -133,8 +144,9 @@ bool Solution::has_point(int i) const {
   return points_.find(i) != points_.end();
 }
 
-std::ostream& operator<<(std::ostream& os, Solution& solution) {
+std::ostream& operator<<(std::ostream& os, const Solution& solution) {
   std::set<int>::iterator point{solution.begin()};
+  if (point == solution.end()) return os;
   os << *point;
   for (++point; point != solution.end(); ++point) {
     os << "-" << *point;
@@ -17,6 +17,8 @@
 #include <vector>
 #include <set>
 #include <cmath>
+#include <random>
+#include <iterator>
 
 typedef std::vector<double> Point;
 
@@ -44,4 +46,15 @@ T random(const std::set<T>& set) {
   return *it;
 }
 
+/**
+ * @brief Picks a random element of the set with the given generator
+ */
+template <class T>
+T random(const std::set<T>& set, std::mt19937& generator) {
+  std::uniform_int_distribution<int> distribution(0, set.size() - 1);
+  auto it{set.begin()};
+  std::advance(it, distribution(generator));
+  return *it;
+}
+
 #endif  // UTILITIES_H
\ No newline at end of file
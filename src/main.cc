@@ -15,155 +15,292 @@
 #include <fstream>
 #include <filesystem>
 #include <vector>
+#include <algorithm>
 #include <chrono>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <random>
 
 #include "greedy.h"
 #include "local_search.h"
 #include "grasp.h"
 #include "branch_bound.h"
+#include "multi_query.h"
+#include "result_sink.h"
+#include "options.h"
 
-#define N_EXECUTIONS 4
+typedef std::pair<std::string, Problem> Instance;
 
-void printGreedy(std::ostream& os, std::string instance_path, Problem& problem, Greedy& algorithm) {
-  for (int m{2}; m < N_EXECUTIONS + 2; ++m) {
-    auto start = std::chrono::high_resolution_clock::now();
-    Solution solution = algorithm.solve(problem, m);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
-    os << instance_path << "," << problem.size() << "," << problem.dimensions() << "," << m << "," << solution.evaluate(problem) << "," << solution << "," << elapsed.count() << std::endl;
-  }
+Result makeResult(const Instance& instance, int m, const Solution& solution, std::chrono::duration<double> elapsed) {
+  Result result;
+  result.instance = instance.first;
+  result.n = instance.second.size();
+  result.k = instance.second.dimensions();
+  result.m = m;
+  result.z = solution.evaluate(instance.second);
+  result.solution = solution;
+  result.cpu = elapsed.count();
+  return result;
 }
 
-void printLocalSearch(std::ostream& os, std::string instance_path, Problem& problem, Local_Search& algoritm) {
-  for (int m{2}; m < N_EXECUTIONS + 2; ++m) {
-    auto start = std::chrono::high_resolution_clock::now();
-    Solution solution = algoritm.solve(problem, m);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
-    os << instance_path << "," << problem.size() << "," << problem.dimensions() << "," << m << "," << solution.evaluate(problem) << "," << solution << "," << elapsed.count() << std::endl;
-  }
+void printGreedy(Result_Sink& sink, const Instance& instance, int m, Greedy& algorithm) {
+  auto start = std::chrono::high_resolution_clock::now();
+  Solution solution = algorithm.solve(instance.second, m);
+  auto end = std::chrono::high_resolution_clock::now();
+  sink.write(makeResult(instance, m, solution, end - start));
 }
 
-void printGRASP(std::ostream& os, std::string instance_path, Problem& problem, GRASP& algoritm) {
-  for (int m{2}; m < N_EXECUTIONS + 2; ++m) {
-    for (int iterations = 10; iterations <= 20; iterations = iterations + 10) {
-      for (int lrc_size = 2; lrc_size <= 3; ++lrc_size) {
-        auto start = std::chrono::high_resolution_clock::now();
-        Solution solution = algoritm.solve(problem, m, iterations, lrc_size);
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> elapsed = end - start;
-        os << instance_path << "," << problem.size() << "," << problem.dimensions() << "," << m << "," << iterations << "," << lrc_size << "," << solution.evaluate(problem) << "," << solution << "," << elapsed.count() << std::endl;
-      }
-    }
-  }
+void printLocalSearch(Result_Sink& sink, const Instance& instance, int m, Local_Search& algoritm) {
+  auto start = std::chrono::high_resolution_clock::now();
+  Solution solution = algoritm.solve(instance.second, m);
+  auto end = std::chrono::high_resolution_clock::now();
+  sink.write(makeResult(instance, m, solution, end - start));
 }
 
-void printBranchBound(std::ostream& os, std::string instance_path, Problem& problem, Branch_Bound& algoritm, Greedy& greedy, bool depth_search = false) {
-  for (int m{2}; m < N_EXECUTIONS + 2; ++m) {
-    auto start = std::chrono::high_resolution_clock::now();
-    int generated_nodes = 0;
-    double lower_bound = greedy.solve(problem, m).evaluate(problem);
-    Solution solution = algoritm.solve(problem, m, lower_bound, generated_nodes, depth_search);
+void printGRASP(Result_Sink& sink, const Instance& instance, int m, GRASP& algoritm, int iterations, int lrc_size, unsigned seed) {
+  std::mt19937 generator(seed);
+  auto start = std::chrono::high_resolution_clock::now();
+  Solution solution = algoritm.solve(instance.second, m, iterations, lrc_size, generator);
+  auto end = std::chrono::high_resolution_clock::now();
+  Result result = makeResult(instance, m, solution, end - start);
+  result.iterations = iterations;
+  result.lrc_size = lrc_size;
+  sink.write(result);
+}
+
+void printBranchBound(Result_Sink& sink, const Instance& instance, int m, Branch_Bound& algoritm, Greedy& greedy, bool depth_search) {
+  auto start = std::chrono::high_resolution_clock::now();
+  int generated_nodes = 0;
+  Solution solution = algoritm.solve(instance.second, m, greedy.solve(instance.second, m), generated_nodes, depth_search);
+  auto end = std::chrono::high_resolution_clock::now();
+  Result result = makeResult(instance, m, solution, end - start);
+  result.generated_nodes = generated_nodes;
+  sink.write(result);
+}
+
+void printBranchBound(Result_Sink& sink, const Instance& instance, int m, Branch_Bound& algoritm, GRASP& grasp, int iterations, int lrc_size, unsigned seed, bool depth_search) {
+  std::mt19937 generator(seed);
+  auto start = std::chrono::high_resolution_clock::now();
+  int generated_nodes = 0;
+  Solution solution = algoritm.solve(instance.second, m, grasp.solve(instance.second, m, iterations, lrc_size, generator), generated_nodes, depth_search);
+  auto end = std::chrono::high_resolution_clock::now();
+  Result result = makeResult(instance, m, solution, end - start);
+  result.generated_nodes = generated_nodes;
+  sink.write(result);
+}
+
+/**
+ * @brief Solves every m of the instance with the local search of a single
+ *        Multi_Query. The time of the shared preprocessing is added to the
+ *        first m
+ */
+void printLocalSearch(Result_Sink& sink, const Instance& instance, const std::vector<int>& m_values) {
+  auto start = std::chrono::high_resolution_clock::now();
+  Multi_Query multi_query(instance.second);
+  for (int m: m_values) {
+    Solution solution = multi_query.local_search(m);
     auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
-    os << instance_path << "," << problem.size() << "," << problem.dimensions() << "," << m << "," << solution.evaluate(problem) << "," << solution << "," << elapsed.count() << "," << generated_nodes << std::endl;
+    sink.write(makeResult(instance, m, solution, end - start));
+    start = end;
   }
 }
 
-void printBranchBound(std::ostream& os, std::string instance_path, Problem& problem, Branch_Bound& algoritm, GRASP& grasp, bool depth_search = false) {
-  for (int m{2}; m < N_EXECUTIONS + 2; ++m) {
-    auto start = std::chrono::high_resolution_clock::now();
+void printBranchBound(Result_Sink& sink, const Instance& instance, const std::vector<int>& m_values, Branch_Bound& algoritm, bool depth_search) {
+  auto start = std::chrono::high_resolution_clock::now();
+  Multi_Query multi_query(instance.second);
+  for (int m: m_values) {
     int generated_nodes = 0;
-    double lower_bound = grasp.solve(problem, m, 30, 3).evaluate(problem);
-    Solution solution = algoritm.solve(problem, m, lower_bound, generated_nodes, depth_search);
+    Solution solution = multi_query.branch_bound(m, algoritm, generated_nodes, depth_search);
     auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> elapsed = end - start;
-    os << instance_path << "," << problem.size() << "," << problem.dimensions() << "," << m << "," << solution.evaluate(problem) << "," << solution << "," << elapsed.count() << "," << generated_nodes << std::endl;
+    Result result = makeResult(instance, m, solution, end - start);
+    result.generated_nodes = generated_nodes;
+    sink.write(result);
+    start = end;
+  }
+}
+
+/**
+ * @brief Runs the jobs on the given number of threads and waits for all of them
+ */
+void runJobs(const std::vector<std::function<void()>>& jobs, int threads) {
+  if (threads <= 1 || jobs.size() <= 1) {
+    for (const std::function<void()>& job: jobs) job();
+    return;
+  }
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> workers;
+  for (int i{0}; i < threads && i < jobs.size(); ++i) {
+    workers.emplace_back([&jobs, &next] {
+      for (size_t job{next++}; job < jobs.size(); job = next++) {
+        jobs[job]();
+      }
+    });
   }
+  for (std::thread& worker: workers) worker.join();
 }
 
 Problem loadProblem(std::string instance_path) {
   std::ifstream file(instance_path);
   if (!file.is_open()) {
-    std::cout << "Error opening file " << instance_path << std::endl;
-    throw;
+    throw std::runtime_error("Error opening file " + instance_path);
   }
   int m, n;
   file >> m >> n;
+  if (!file || m <= 0 || n <= 0) {
+    throw std::runtime_error("Invalid instance " + instance_path);
+  }
   Problem problem(m, n);
   for (int i{0}; i < m; ++i) {
     for (int j{0}; j < n; ++j) {
-      file >> problem[i][j];
+      if (!(file >> problem[i][j])) {
+        throw std::runtime_error("Invalid instance " + instance_path);
+      }
     }
   }
   file.close();
   return problem;
 }
 
-int main(int argc, char** argv) {
-  srand(time(0));
-  if (argc < 2) {
-    std::cout << "Usage: " << argv[0] << " <instance_folder>" << std::endl;
-    return 1;
+/**
+ * @brief Loads a single instance file or every instance of a folder
+ */
+std::vector<Instance> loadInstances(std::string path) {
+  std::vector<Instance> instances;
+  if (!std::filesystem::is_directory(path)) {
+    instances.emplace_back(path, loadProblem(path));
+    return instances;
   }
-  std::string instance_folder = argv[1];
-
-  Greedy greedy;
-  std::cout << "Algoritmo constructivo voraz" << std::endl;
-  std::cout << "Problema,n,k,m,z,S,CPU(s)" << std::endl;
-  for (const auto& entry : std::filesystem::directory_iterator(instance_folder)) {
+  for (const auto& entry : std::filesystem::directory_iterator(path)) {
     std::string instance_path = entry.path();
-    Problem matrix = loadProblem(instance_path);
-    printGreedy(std::cout, instance_path, matrix, greedy);
+    instances.emplace_back(instance_path, loadProblem(instance_path));
   }
+  return instances;
+}
 
-  Local_Search localsearch;
-  std::cout << "Algoritmo de búsqueda local" << std::endl;
-  std::cout << "Problema,n,k,m,z,S,CPU(s)" << std::endl;
-  for (const auto& entry : std::filesystem::directory_iterator(instance_folder)) {
-    std::string instance_path = entry.path();
-    Problem matrix = loadProblem(instance_path);
-    printLocalSearch(std::cout, instance_path, matrix, localsearch);
+int main(int argc, char** argv) {
+  Options options;
+  try {
+    options = parseOptions(argc, argv);
+  } catch (const std::invalid_argument& error) {
+    std::cerr << error.what() << std::endl;
+    printUsage(std::cerr, argv[0]);
+    return 1;
   }
-
-  GRASP grasp;
-  std::cout << "Algoritmo GRASP" << std::endl;
-  std::cout << "Problema,n,k,m,Iter,|LRC|,z,S,CPU(s)" << std::endl;
-  for (const auto& entry : std::filesystem::directory_iterator(instance_folder)) {
-    std::string instance_path = entry.path();
-    Problem matrix = loadProblem(instance_path);
-    printGRASP(std::cout, instance_path, matrix, grasp);
+  srand(options.seed);
+  std::vector<Instance> instances;
+  try {
+    instances = loadInstances(options.instance_path);
+  } catch (const std::runtime_error& error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
+  std::vector<std::pair<const Instance*, int>> executions;
+  std::vector<std::pair<const Instance*, std::vector<int>>> queries;
+  for (const Instance& instance: instances) {
+    queries.emplace_back(&instance, std::vector<int>());
+    for (int m: options.m_values) {
+      if (m > instance.second.size()) {
+        std::cerr << "Skipping m=" << m << " for " << instance.first << ": it only has " << instance.second.size() << " points" << std::endl;
+        continue;
+      }
+      executions.emplace_back(&instance, m);
+      queries.back().second.push_back(m);
+    }
+    std::sort(queries.back().second.begin(), queries.back().second.end());
   }
 
+  CSV_Sink csv(std::cout);
+  JSON_Lines_Sink json_lines(std::cout);
+  Result_Sink& output = options.json ? static_cast<Result_Sink&>(json_lines) : csv;
+  Async_Sink sink(output);
+  const std::vector<Field> kFields{Field::kInstance, Field::kN, Field::kK, Field::kM, Field::kZ, Field::kSolution, Field::kCpu};
+  const std::vector<Field> kGRASPFields{Field::kInstance, Field::kN, Field::kK, Field::kM, Field::kIterations, Field::kLrcSize, Field::kZ, Field::kSolution, Field::kCpu};
+  const std::vector<Field> kBranchBoundFields{Field::kInstance, Field::kN, Field::kK, Field::kM, Field::kZ, Field::kSolution, Field::kCpu, Field::kGeneratedNodes};
+
+  Greedy greedy;
+  Local_Search localsearch;
+  GRASP grasp;
   Branch_Bound branch_bound;
-  std::cout << "Algoritmo de ramificación y poda - Voraz - Cota superior más pequeña" << std::endl;
-  std::cout << "Problema,n,k,m,z,S,CPU(s),nodos" << std::endl;
-  for (const auto& entry : std::filesystem::directory_iterator(instance_folder)) {
-    std::string instance_path = entry.path();
-    Problem matrix = loadProblem(instance_path);
-    printBranchBound(std::cout, instance_path, matrix, branch_bound, greedy);
+  grasp.set_time_limit(options.time_limit);
+  branch_bound.set_time_limit(options.time_limit);
+  branch_bound.set_concurrent_heuristic(options.concurrent_lrc_size);
+  std::vector<std::function<void()>> jobs;
+  // Each randomised job gets its own generator, seeded from --seed and the
+  // order in which the job is created, so results do not depend on threads
+  unsigned n_seeds{0};
+
+  if (options.greedy) {
+    sink.begin_section({"Algoritmo constructivo voraz", kFields});
+    for (const auto& [instance, m]: executions) {
+      jobs.push_back([&, instance = instance, m = m] { printGreedy(sink, *instance, m, greedy); });
+    }
+    runJobs(jobs, options.threads);
+    jobs.clear();
   }
-  std::cout << "Algoritmo de ramificación y poda - GRASP - Cota superior más pequeña" << std::endl;
-  std::cout << "Problema,n,k,m,z,S,CPU(s),nodos" << std::endl;
-  for (const auto& entry : std::filesystem::directory_iterator(instance_folder)) {
-    std::string instance_path = entry.path();
-    Problem matrix = loadProblem(instance_path);
-    printBranchBound(std::cout, instance_path, matrix, branch_bound, grasp);
+
+  if (options.local_search) {
+    if (options.multi_query) {
+      sink.begin_section({"Algoritmo de búsqueda local - Multi", kFields});
+      for (const auto& [instance, m_values]: queries) {
+        jobs.push_back([&, instance = instance, &m_values = m_values] { printLocalSearch(sink, *instance, m_values); });
+      }
+    } else {
+      sink.begin_section({"Algoritmo de búsqueda local", kFields});
+      for (const auto& [instance, m]: executions) {
+        jobs.push_back([&, instance = instance, m = m] { printLocalSearch(sink, *instance, m, localsearch); });
+      }
+    }
+    runJobs(jobs, options.threads);
+    jobs.clear();
   }
-  std::cout << "Algoritmo de ramificación y poda - Voraz - Búsqueda en profundidad" << std::endl;
-  std::cout << "Problema,n,k,m,z,S,CPU(s),nodos" << std::endl;
-  for (const auto& entry : std::filesystem::directory_iterator(instance_folder)) {
-    std::string instance_path = entry.path();
-    Problem matrix = loadProblem(instance_path);
-    printBranchBound(std::cout, instance_path, matrix, branch_bound, greedy, true);
+
+  if (options.grasp) {
+    sink.begin_section({"Algoritmo GRASP", kGRASPFields});
+    for (const auto& [instance, m]: executions) {
+      for (int iterations: options.iterations) {
+        for (int lrc_size: options.lrc_sizes) {
+          jobs.push_back([&, instance = instance, m = m, iterations, lrc_size, seed = options.seed + n_seeds++] { printGRASP(sink, *instance, m, grasp, iterations, lrc_size, seed); });
+        }
+      }
+    }
+    runJobs(jobs, options.threads);
+    jobs.clear();
   }
-  std::cout << "Algoritmo de ramificación y poda - GRASP - Búsqueda en profundidad" << std::endl;
-  std::cout << "Problema,n,k,m,z,S,CPU(s),nodos" << std::endl;
-  for (const auto& entry : std::filesystem::directory_iterator(instance_folder)) {
-    std::string instance_path = entry.path();
-    Problem matrix = loadProblem(instance_path);
-    printBranchBound(std::cout, instance_path, matrix, branch_bound, grasp, true);
+
+  if (options.branch_bound) {
+    for (bool depth_search: {false, true}) {
+      if (depth_search ? !options.depth_first : !options.best_first) continue;
+      std::string strategy = depth_search ? "Búsqueda en profundidad" : "Cota superior más pequeña";
+      if (options.multi_query) {
+        sink.begin_section({"Algoritmo de ramificación y poda - Multi - " + strategy, kBranchBoundFields});
+        for (const auto& [instance, m_values]: queries) {
+          jobs.push_back([&, instance = instance, &m_values = m_values, depth_search] { printBranchBound(sink, *instance, m_values, branch_bound, depth_search); });
+        }
+        runJobs(jobs, options.threads);
+        jobs.clear();
+        continue;
+      }
+      if (options.greedy_bound) {
+        sink.begin_section({"Algoritmo de ramificación y poda - Voraz - " + strategy, kBranchBoundFields});
+        for (const auto& [instance, m]: executions) {
+          jobs.push_back([&, instance = instance, m = m, depth_search] { printBranchBound(sink, *instance, m, branch_bound, greedy, depth_search); });
+        }
+        runJobs(jobs, options.threads);
+        jobs.clear();
+      }
+      if (options.grasp_bound) {
+        sink.begin_section({"Algoritmo de ramificación y poda - GRASP - " + strategy, kBranchBoundFields});
+        for (const auto& [instance, m]: executions) {
+          jobs.push_back([&, instance = instance, m = m, depth_search, seed = options.seed + n_seeds++] { printBranchBound(sink, *instance, m, branch_bound, grasp, options.bound_iterations, options.bound_lrc_size, seed, depth_search); });
+        }
+        runJobs(jobs, options.threads);
+        jobs.clear();
+      }
+    }
   }
 
+  sink.close();
   return 0;
-}
\ No newline at end of file
+}
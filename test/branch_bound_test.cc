@@ -0,0 +1,115 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Diseño y Análisis de Algoritmos
+ *
+ * @author Miguel Luna García
+ * @since 21 Apr 2023
+ * @file branch_bound_test.cc
+ * @brief Branch_Bound test
+ *        This program checks Branch_Bound against an exhaustive enumeration on
+ *        small random and clustered instances, for every m from 1 to n
+ */
+
+#include <iostream>
+#include <cmath>
+#include <random>
+#include <string>
+
+#include "branch_bound.h"
+#include "multi_query.h"
+
+#define N_INSTANCES 100
+#define MAX_POINTS 10
+
+/**
+ * @brief Best value of any subset of m points, by enumerating all of them.
+ *        The worst subset is also returned, to be used as a poor incumbent
+ */
+double bruteForce(const Problem& problem, int m, Solution& worst_solution) {
+  Distance_Matrix distances(problem);
+  double best_value{-1};
+  double worst_value{-1};
+  for (int mask{0}; mask < (1 << problem.size()); ++mask) {
+    if (__builtin_popcount(mask) != m) continue;
+    Solution solution;
+    for (int i{0}; i < problem.size(); ++i) {
+      if (mask & (1 << i)) solution.insert(i);
+    }
+    double value = distances.evaluate(solution);
+    best_value = std::max(best_value, value);
+    if (worst_value < 0 || value < worst_value) {
+      worst_value = value;
+      worst_solution = solution;
+    }
+  }
+  return best_value;
+}
+
+Problem randomProblem(std::mt19937& generator, int n) {
+  std::uniform_real_distribution<double> coordinate(0, 10);
+  Problem problem(n, 2);
+  for (int i{0}; i < n; ++i) {
+    problem[i] = Point{coordinate(generator), coordinate(generator)};
+  }
+  return problem;
+}
+
+/**
+ * @brief Points spread around two or three centres, so many of them are
+ *        nearly interchangeable
+ */
+Problem clusteredProblem(std::mt19937& generator, int n) {
+  std::uniform_real_distribution<double> coordinate(0, 10);
+  std::normal_distribution<double> noise(0, 0.2);
+  std::vector<Point> centres(2 + generator() % 2);
+  for (Point& centre: centres) {
+    centre = Point{coordinate(generator), coordinate(generator)};
+  }
+  Problem problem(n, 2);
+  for (int i{0}; i < n; ++i) {
+    const Point& centre = centres[i % centres.size()];
+    problem[i] = Point{centre[0] + noise(generator), centre[1] + noise(generator)};
+  }
+  return problem;
+}
+
+bool check(const std::string& name, const Problem& problem, int m, const Solution& solution, double expected) {
+  double value = solution.evaluate(problem);
+  if (solution.size() == m && std::abs(value - expected) <= 1e-9 * std::max(1.0, expected)) return true;
+  std::cout << name << ": n=" << problem.size() << " m=" << m << " got " << value << " with " << solution.size() << " points, expected " << expected << std::endl;
+  return false;
+}
+
+int main() {
+  std::mt19937 generator(1);
+  Branch_Bound branch_bound;
+  Greedy greedy;
+  int n_checks{0};
+  for (int instance{0}; instance < 2 * N_INSTANCES; ++instance) {
+    int n = 2 + generator() % (MAX_POINTS - 1);
+    Problem problem = instance < N_INSTANCES ? randomProblem(generator, n) : clusteredProblem(generator, n);
+    Multi_Query multi_query(problem);
+    for (int m{1}; m <= n; ++m) {
+      Solution worst_solution;
+      double expected = bruteForce(problem, m, worst_solution);
+      for (bool depth_search: {false, true}) {
+        std::string strategy = depth_search ? "Depth first" : "Best first";
+        int generated_nodes{0};
+        Solution solution = branch_bound.solve(problem, m, greedy.solve(problem, m), generated_nodes, depth_search);
+        if (!check(strategy, problem, m, solution, expected)) return 1;
+        solution = branch_bound.solve(problem, m, Solution(), generated_nodes, depth_search);
+        if (!check(strategy + " without incumbent", problem, m, solution, expected)) return 1;
+        solution = branch_bound.solve(problem, m, worst_solution, generated_nodes, depth_search);
+        if (!check(strategy + " from the worst incumbent", problem, m, solution, expected)) return 1;
+        n_checks += 3;
+      }
+      int generated_nodes{0};
+      if (!check("Multi_Query", problem, m, multi_query.branch_bound(m, branch_bound, generated_nodes), expected)) return 1;
+      ++n_checks;
+    }
+  }
+  std::cout << "Branch_Bound: " << n_checks << " solutions optimal" << std::endl;
+  return 0;
+}
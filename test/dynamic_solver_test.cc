@@ -0,0 +1,101 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Diseño y Análisis de Algoritmos
+ *
+ * @author Miguel Luna García
+ * @since 21 Apr 2023
+ * @file dynamic_solver_test.cc
+ * @brief Dynamic_Solver test
+ *        This program applies random updates to a problem and checks that the
+ *        incremental bookkeeping of Dynamic_Solver matches a full evaluation
+ */
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+
+#include "multi_query.h"
+#include "dynamic_solver.h"
+
+#define N_POINTS 200
+#define M 8
+#define N_UPDATES 2000
+
+/**
+ * @brief Checks that no swap between a point of the solution and a point
+ *        outside it improves the solution
+ */
+bool isLocalOptimum(const Problem& problem, const Solution& solution) {
+  for (int out: solution) {
+    for (int in{0}; in < problem.size(); ++in) {
+      if (solution.has_point(in)) continue;
+      double gain{0};
+      for (int point: solution) {
+        if (point == out) continue;
+        gain += euclidean_distance(problem[in], problem[point]) - euclidean_distance(problem[out], problem[point]);
+      }
+      if (gain > 1e-6) return false;
+    }
+  }
+  return true;
+}
+
+Point randomPoint() {
+  return Point{double(rand() % 1000) / 10, double(rand() % 1000) / 10};
+}
+
+/**
+ * @brief Applies random updates and checks the solver after each one. With
+ *        complete_repair the repair is never cut short, so every update must
+ *        leave the solution at a swap local optimum
+ * @return true if every check passed
+ */
+bool runUpdates(bool complete_repair) {
+  Problem problem(0, 2);
+  for (int i{0}; i < N_POINTS; ++i) {
+    problem.push_back(randomPoint());
+  }
+  Multi_Query multi_query(problem);
+  Dynamic_Solver solver(problem, multi_query.local_search(M));
+  if (complete_repair) solver.set_max_swaps(N_POINTS * N_UPDATES);
+  for (int update{0}; update < N_UPDATES; ++update) {
+    int operation = rand() % 3;
+    if (operation == 0) {
+      solver.add_point(randomPoint());
+    } else if (operation == 1 && problem.size() > M) {
+      solver.remove_point(rand() % problem.size());
+    } else {
+      solver.move_point(rand() % problem.size(), randomPoint());
+    }
+    const Solution& solution = solver.solution();
+    if (solution.size() != M) {
+      std::cout << "Update " << update << ": solution has " << solution.size() << " points, expected " << M << std::endl;
+      return false;
+    }
+    for (int point: solution) {
+      if (point < 0 || point >= problem.size()) {
+        std::cout << "Update " << update << ": point " << point << " is not in the problem" << std::endl;
+        return false;
+      }
+    }
+    double value = solution.evaluate(problem);
+    if (std::abs(value - solver.value()) > 1e-6 * std::max(1.0, value)) {
+      std::cout << "Update " << update << ": value " << solver.value() << " differs from evaluation " << value << std::endl;
+      return false;
+    }
+    if (complete_repair && !isLocalOptimum(problem, solution)) {
+      std::cout << "Update " << update << ": an improving swap remains after the repair" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  srand(1);
+  if (!runUpdates(false) || !runUpdates(true)) return 1;
+  std::cout << "Dynamic_Solver: " << 2 * N_UPDATES << " updates OK" << std::endl;
+  return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * Universidad de La Laguna
+ * Escuela Superior de Ingeniería y Tecnología
+ * Grado en Ingeniería Informática
+ * Diseño y Análisis de Algoritmos
+ *
+ * @author Miguel Luna García
+ * @since 21 Apr 2023
+ * @file result_sink_test.cc
+ * @brief Result sinks test
+ *        This program writes known results through every sink and checks
+ *        the output they produce
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "result_sink.h"
+
+#define N_RESULTS 1000
+
+Result makeResult(const std::string& instance, int m) {
+  Result result;
+  result.instance = instance;
+  result.n = 15;
+  result.k = 2;
+  result.m = m;
+  result.iterations = 10;
+  result.lrc_size = 3;
+  result.z = 12.5;
+  for (int i{0}; i < m; ++i) {
+    result.solution.insert(2 * i);
+  }
+  result.cpu = 0.25;
+  result.generated_nodes = 42;
+  return result;
+}
+
+bool check(const std::string& name, const std::string& output, const std::string& expected) {
+  if (output == expected) return true;
+  std::cout << name << ": got" << std::endl << output << "expected" << std::endl << expected;
+  return false;
+}
+
+int main() {
+  const std::string kInstance{"dir/a\"b\\c\td.txt"};
+  const Section kSection{"Algoritmo GRASP", {Field::kInstance, Field::kM, Field::kIterations, Field::kLrcSize, Field::kZ, Field::kSolution, Field::kCpu}};
+  const Section kBranchBoundSection{"Ramificación y poda", {Field::kM, Field::kSolution, Field::kGeneratedNodes}};
+  bool ok{true};
+
+  std::ostringstream csv_output;
+  {
+    CSV_Sink csv(csv_output, 16);
+    csv.begin_section(kSection);
+    csv.write(makeResult(kInstance, 3));
+    csv.begin_section(kBranchBoundSection);
+    csv.write(makeResult(kInstance, 2));
+  }
+  ok &= check("CSV_Sink", csv_output.str(),
+              "Algoritmo GRASP\n"
+              "Problema,m,Iter,|LRC|,z,S,CPU(s)\n"
+              "dir/a\"b\\c\td.txt,3,10,3,12.5,0-2-4,0.25\n"
+              "Ramificación y poda\n"
+              "m,S,nodos\n"
+              "2,0-2,42\n");
+
+  std::ostringstream json_output;
+  {
+    JSON_Lines_Sink json_lines(json_output);
+    json_lines.begin_section(kSection);
+    json_lines.write(makeResult(kInstance, 3));
+    json_lines.write(makeResult("\x01\r\n", 1));
+    json_lines.begin_section(kBranchBoundSection);
+    json_lines.write(makeResult(kInstance, 2));
+  }
+  ok &= check("JSON_Lines_Sink", json_output.str(),
+              "{\"algorithm\":\"Algoritmo GRASP\",\"instance\":\"dir/a\\\"b\\\\c\\u0009d.txt\",\"m\":3,\"iterations\":10,\"lrc_size\":3,\"z\":12.5,\"solution\":[0,2,4],\"cpu\":0.25}\n"
+              "{\"algorithm\":\"Algoritmo GRASP\",\"instance\":\"\\u0001\\u000d\\n\",\"m\":1,\"iterations\":10,\"lrc_size\":3,\"z\":12.5,\"solution\":[0],\"cpu\":0.25}\n"
+              "{\"algorithm\":\"Ramificación y poda\",\"m\":2,\"solution\":[0,2],\"generated_nodes\":42}\n");
+
+  Memory_Sink memory;
+  {
+    Async_Sink sink(memory);
+    sink.begin_section(kSection);
+    for (int i{0}; i < N_RESULTS; ++i) {
+      sink.write(makeResult(std::to_string(i), 2));
+    }
+    sink.flush();
+    if (memory.results().size() != N_RESULTS) {
+      std::cout << "Async_Sink: flush left " << N_RESULTS - memory.results().size() << " results pending" << std::endl;
+      ok = false;
+    }
+    sink.begin_section(kBranchBoundSection);
+    sink.close();
+    sink.write(makeResult(kInstance, 3));
+  }
+  if (memory.sections().size() != 2 || memory.sections()[1].title != kBranchBoundSection.title) {
+    std::cout << "Async_Sink: expected 2 sections, got " << memory.sections().size() << std::endl;
+    ok = false;
+  }
+  if (memory.results().size() != N_RESULTS + 1) {
+    std::cout << "Async_Sink: expected " << N_RESULTS + 1 << " results, got " << memory.results().size() << std::endl;
+    ok = false;
+  }
+  for (int i{0}; ok && i < N_RESULTS; ++i) {
+    if (memory.results()[i].instance != std::to_string(i)) {
+      std::cout << "Async_Sink: result " << i << " out of order" << std::endl;
+      ok = false;
+    }
+  }
+  if (ok && memory.results().back().instance != kInstance) {
+    std::cout << "Async_Sink: result written after close was lost" << std::endl;
+    ok = false;
+  }
+
+  if (!ok) return 1;
+  std::cout << "Result sinks: OK" << std::endl;
+  return 0;
+}